@@ -11,4 +11,18 @@ struct ListDistanceFun {
 struct ListDistanceAlgorithms {
 	static vector<AggregateFunction> GetAlgorithms();
 };
+
+struct ListBoundsFun {
+	static vector<AggregateFunction> GetAggregates();
+	static ScalarFunction GetBoxDistanceFunction();
+
+	// Distance along one dimension from `value` to the closest edge of [lower, upper], 0 if inside
+	static inline double BoxDelta(double value, double lower, double upper) {
+		return MaxValue(MaxValue(lower - value, value - upper), 0.0);
+	}
+};
+
+struct VectorSearchFun {
+	static vector<TableFunction> GetFunctions();
+};
 } // namespace duckdb
\ No newline at end of file
@@ -0,0 +1,268 @@
+#include "distance_functions.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/types/vector.hpp"
+#include "duckdb/function/aggregate_function.hpp"
+#include "duckdb/function/scalar_function.hpp"
+
+#include <cmath>
+
+namespace duckdb {
+
+// Per-dimension bounds of a group of vectors.
+// The bounds are allocated in the aggregate's arena, so the state needs no destructor.
+struct ListBoundState {
+	bool is_set;
+	idx_t dimension;
+	double *bounds;
+};
+
+static void ListBoundCheckDimension(const ListBoundState &state, idx_t dimension) {
+	if (state.dimension != dimension) {
+		throw InvalidInputException("Vectors must have the same dimension: expected %llu, got %llu", state.dimension,
+		                            dimension);
+	}
+}
+
+// NaN compares false against everything, so a single NaN would make the bounds depend on the input order
+static double ListBoundCheckElement(bool is_valid, double value) {
+	if (!is_valid) {
+		throw InvalidInputException("Vector elements must not be NULL");
+	}
+	if (std::isnan(value)) {
+		throw InvalidInputException("Vector elements must not be NaN");
+	}
+	return value;
+}
+
+static void ListBoundAllocate(ListBoundState &state, idx_t dimension, AggregateInputData &aggr_input_data) {
+	state.is_set = true;
+	state.dimension = dimension;
+	if (dimension > 0) {
+		state.bounds = reinterpret_cast<double *>(aggr_input_data.allocator.Allocate(dimension * sizeof(double)));
+	}
+}
+
+// AggregateFunction::UnaryAggregate only handles fixed-size input and result types, so the LIST input and
+// result are unpacked here and each element is handed to OP::Operation.
+template <class OP>
+struct ListBoundAggregate {
+	template <class STATE>
+	static void Initialize(STATE &state) {
+		state.is_set = false;
+		state.dimension = 0;
+		state.bounds = nullptr;
+	}
+
+	static void Update(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count, Vector &state_vector,
+	                   idx_t count) {
+		D_ASSERT(input_count == 1);
+		auto &input = inputs[0];
+
+		UnifiedVectorFormat input_data;
+		input.ToUnifiedFormat(count, input_data);
+		auto entries = UnifiedVectorFormat::GetData<list_entry_t>(input_data);
+
+		auto &child = ListVector::GetEntry(input);
+		UnifiedVectorFormat child_data;
+		child.ToUnifiedFormat(ListVector::GetListSize(input), child_data);
+		auto child_values = UnifiedVectorFormat::GetData<double>(child_data);
+
+		UnifiedVectorFormat sdata;
+		state_vector.ToUnifiedFormat(count, sdata);
+		auto states = UnifiedVectorFormat::GetData<ListBoundState *>(sdata);
+
+		for (idx_t i = 0; i < count; i++) {
+			auto input_idx = input_data.sel->get_index(i);
+			if (!input_data.validity.RowIsValid(input_idx)) {
+				continue;
+			}
+			const auto &entry = entries[input_idx];
+			auto &state = *states[sdata.sel->get_index(i)];
+
+			// the first vector initializes the bounds
+			bool is_first = !state.is_set;
+			if (is_first) {
+				ListBoundAllocate(state, entry.length, aggr_input_data);
+			}
+			ListBoundCheckDimension(state, entry.length);
+
+			for (idx_t j = 0; j < entry.length; j++) {
+				auto child_idx = child_data.sel->get_index(entry.offset + j);
+				auto value = ListBoundCheckElement(child_data.validity.RowIsValid(child_idx), child_values[child_idx]);
+				if (is_first) {
+					state.bounds[j] = value;
+				} else {
+					OP::Operation(state.bounds[j], value);
+				}
+			}
+		}
+	}
+
+	static void Combine(Vector &state_vector, Vector &combined, AggregateInputData &aggr_input_data, idx_t count) {
+		UnifiedVectorFormat sdata;
+		state_vector.ToUnifiedFormat(count, sdata);
+		auto states = UnifiedVectorFormat::GetData<ListBoundState *>(sdata);
+		auto combined_states = FlatVector::GetData<ListBoundState *>(combined);
+
+		for (idx_t i = 0; i < count; i++) {
+			auto &source = *states[sdata.sel->get_index(i)];
+			auto &target = *combined_states[i];
+			if (!source.is_set) {
+				continue;
+			}
+			if (!target.is_set) {
+				ListBoundAllocate(target, source.dimension, aggr_input_data);
+				for (idx_t j = 0; j < source.dimension; j++) {
+					target.bounds[j] = source.bounds[j];
+				}
+				continue;
+			}
+			ListBoundCheckDimension(target, source.dimension);
+			for (idx_t j = 0; j < target.dimension; j++) {
+				OP::Operation(target.bounds[j], source.bounds[j]);
+			}
+		}
+	}
+
+	static void Finalize(Vector &state_vector, AggregateInputData &, Vector &result, idx_t count, idx_t offset) {
+		UnifiedVectorFormat sdata;
+		state_vector.ToUnifiedFormat(count, sdata);
+		auto states = UnifiedVectorFormat::GetData<ListBoundState *>(sdata);
+
+		auto &result_validity = FlatVector::Validity(result);
+		auto result_entries = FlatVector::GetData<list_entry_t>(result);
+
+		for (idx_t i = 0; i < count; i++) {
+			auto &state = *states[sdata.sel->get_index(i)];
+			auto result_idx = i + offset;
+			if (!state.is_set) {
+				result_validity.SetInvalid(result_idx);
+				continue;
+			}
+
+			auto list_size = ListVector::GetListSize(result);
+			ListVector::Reserve(result, list_size + state.dimension);
+			auto child_values = FlatVector::GetData<double>(ListVector::GetEntry(result));
+			for (idx_t j = 0; j < state.dimension; j++) {
+				child_values[list_size + j] = state.bounds[j];
+			}
+			result_entries[result_idx].offset = list_size;
+			result_entries[result_idx].length = state.dimension;
+			ListVector::SetListSize(result, list_size + state.dimension);
+		}
+	}
+
+	static AggregateFunction GetFunction() {
+		auto vector_type = LogicalType::LIST(LogicalType::DOUBLE);
+		return AggregateFunction({vector_type}, vector_type, AggregateFunction::StateSize<ListBoundState>,
+		                         AggregateFunction::StateInitialize<ListBoundState, ListBoundAggregate>, Update,
+		                         Combine, Finalize);
+	}
+};
+
+struct ListMinBound {
+	static void Operation(double &bound, double input) {
+		bound = MinValue(bound, input);
+	}
+
+	static AggregateFunction GetFunction() {
+		auto fn = ListBoundAggregate<ListMinBound>::GetFunction();
+		fn.name = "list_min_bound";
+		return fn;
+	}
+};
+
+struct ListMaxBound {
+	static void Operation(double &bound, double input) {
+		bound = MaxValue(bound, input);
+	}
+
+	static AggregateFunction GetFunction() {
+		auto fn = ListBoundAggregate<ListMaxBound>::GetFunction();
+		fn.name = "list_max_bound";
+		return fn;
+	}
+};
+
+// Call is of the form:
+// list_box_l2distance(search_l, lower, upper)
+// search_l is the search vector
+// lower and upper are the per-dimension bounds of a group of vectors (see `list_min_bound` and `list_max_bound`)
+// Returns the distance from search_l to the closest point of the box, which is a lower bound of
+// list_l2distance(v, search_l) for every vector v inside the box.
+static void ListBoxL2DistanceFunction(DataChunk &args, ExpressionState &, Vector &result) {
+	auto count = args.size();
+
+	UnifiedVectorFormat list_data[3];
+	UnifiedVectorFormat child_data[3];
+	const list_entry_t *entries[3];
+	const double *child_values[3];
+	for (idx_t arg_idx = 0; arg_idx < 3; arg_idx++) {
+		auto &list = args.data[arg_idx];
+		list.ToUnifiedFormat(count, list_data[arg_idx]);
+		entries[arg_idx] = UnifiedVectorFormat::GetData<list_entry_t>(list_data[arg_idx]);
+		auto &child = ListVector::GetEntry(list);
+		child.ToUnifiedFormat(ListVector::GetListSize(list), child_data[arg_idx]);
+		child_values[arg_idx] = UnifiedVectorFormat::GetData<double>(child_data[arg_idx]);
+	}
+
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto result_data = FlatVector::GetData<double>(result);
+	auto &result_validity = FlatVector::Validity(result);
+
+	for (idx_t i = 0; i < count; i++) {
+		list_entry_t row_entries[3];
+		bool is_valid = true;
+		for (idx_t arg_idx = 0; arg_idx < 3; arg_idx++) {
+			auto list_idx = list_data[arg_idx].sel->get_index(i);
+			if (!list_data[arg_idx].validity.RowIsValid(list_idx)) {
+				is_valid = false;
+				break;
+			}
+			row_entries[arg_idx] = entries[arg_idx][list_idx];
+		}
+		if (!is_valid) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+
+		auto length = row_entries[0].length;
+		for (idx_t arg_idx = 1; arg_idx < 3; arg_idx++) {
+			if (row_entries[arg_idx].length != length) {
+				throw InvalidInputException("Vectors must have the same dimension: expected %llu, got %llu", length,
+				                            row_entries[arg_idx].length);
+			}
+		}
+
+		double distance = 0;
+		for (idx_t j = 0; j < length; j++) {
+			double values[3];
+			for (idx_t arg_idx = 0; arg_idx < 3; arg_idx++) {
+				auto child_idx = child_data[arg_idx].sel->get_index(row_entries[arg_idx].offset + j);
+				values[arg_idx] = ListBoundCheckElement(child_data[arg_idx].validity.RowIsValid(child_idx),
+				                                        child_values[arg_idx][child_idx]);
+			}
+			auto delta = ListBoundsFun::BoxDelta(values[0], values[1], values[2]);
+			distance += delta * delta;
+		}
+		result_data[i] = sqrt(distance);
+	}
+	if (args.AllConstant()) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
+	}
+}
+
+vector<AggregateFunction> ListBoundsFun::GetAggregates() {
+	vector<AggregateFunction> aggregates;
+	aggregates.push_back(ListMinBound::GetFunction());
+	aggregates.push_back(ListMaxBound::GetFunction());
+	return aggregates;
+}
+
+ScalarFunction ListBoundsFun::GetBoxDistanceFunction() {
+	auto vector_type = LogicalType::LIST(LogicalType::DOUBLE);
+	return ScalarFunction("list_box_l2distance", {vector_type, vector_type, vector_type}, LogicalType::DOUBLE,
+	                      ListBoxL2DistanceFunction);
+}
+
+} // namespace duckdb
@@ -159,13 +159,16 @@ static void ListDistanceFunction(DataChunk &args, ExpressionState &state, Vector
 		auto search_l_index = search_l_data.sel->get_index(i);
 		const auto &l_entry = l_entries[l_index];
 		const auto &search_l_entry = search_l_entries[search_l_index];
-		D_ASSERT(l_entry.length == search_l_entry.length);
 
 		// nothing to do for this list
 		if (!l_data.validity.RowIsValid(l_index) || !search_l_data.validity.RowIsValid(search_l_index)) {
 			result_validity.SetInvalid(i);
 			continue;
 		}
+		if (l_entry.length != search_l_entry.length) {
+			throw InvalidInputException("Vectors must have the same dimension: expected %llu, got %llu",
+			                            search_l_entry.length, l_entry.length);
+		}
 		if (l_entry.length == 0 || search_l_entry.length == 0)
 			continue;
 
@@ -31,6 +31,17 @@ static void LoadInternal(DatabaseInstance &instance) {
 		ExtensionUtil::RegisterFunction(instance, distance_fn);
 	}
 
+	// Register vector bounds and their lower-bound distances
+	for (const auto &bound_fn : ListBoundsFun::GetAggregates()) {
+		ExtensionUtil::RegisterFunction(instance, bound_fn);
+	}
+	ExtensionUtil::RegisterFunction(instance, ListBoundsFun::GetBoxDistanceFunction());
+
+	// Register the pruned vector searches
+	for (const auto &search_fn : VectorSearchFun::GetFunctions()) {
+		ExtensionUtil::RegisterFunction(instance, search_fn);
+	}
+
 	for (auto macro : vector_macros) {
 		auto info = DefaultFunctionGenerator::CreateInternalMacroInfo(macro);
 		ExtensionUtil::RegisterFunction(instance, *info);
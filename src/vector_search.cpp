@@ -0,0 +1,404 @@
+#include "distance_functions.hpp"
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace duckdb {
+
+// The vector search table functions keep per-group bounds of a vector column in a table named
+// `<table>_<column>_bounds`, built by `vector_analyze`. The searches compute the lower bound of every group from it
+// and only read and score the rows of the groups that can still hold a match.
+// All queries run on a separate connection, so they see committed data only.
+
+struct VectorBoundsBindData : public TableFunctionData {
+	string table;
+	string column;
+	string group_column;
+
+	string BoundsTable() const {
+		return table + "_" + column + "_bounds";
+	}
+};
+
+struct VectorSearchBindData : public VectorBoundsBindData {
+	vector<double> search_l;
+	double radius = 0;
+	idx_t k = 0;
+};
+
+struct VectorSearchMatch {
+	int64_t row_id;
+	vector<double> values;
+	double distance;
+};
+
+struct VectorGroupBound {
+	Value group;
+	double bound;
+};
+
+static string Quote(const string &name) {
+	return KeywordHelper::WriteOptionallyQuoted(name);
+}
+
+static unique_ptr<MaterializedQueryResult> RunQuery(Connection &con, const string &query) {
+	auto result = con.Query(query);
+	if (result->HasError()) {
+		throw InvalidInputException(result->GetError());
+	}
+	return result;
+}
+
+static void CheckDimension(idx_t expected, idx_t dimension) {
+	if (expected != dimension) {
+		throw InvalidInputException("Vectors must have the same dimension: expected %llu, got %llu", expected,
+		                            dimension);
+	}
+}
+
+static double CheckElement(const Value &value) {
+	if (value.IsNull()) {
+		throw InvalidInputException("Vector elements must not be NULL");
+	}
+	auto element = value.GetValue<double>();
+	if (std::isnan(element)) {
+		throw InvalidInputException("Vector elements must not be NaN");
+	}
+	return element;
+}
+
+static void VectorBoundsBind(VectorBoundsBindData &bind_data, TableFunctionBindInput &input) {
+	for (idx_t i = 0; i < 3; i++) {
+		if (input.inputs[i].IsNull()) {
+			throw BinderException("Table, column and group column must not be NULL");
+		}
+	}
+	bind_data.table = input.inputs[0].GetValue<string>();
+	bind_data.column = input.inputs[1].GetValue<string>();
+	bind_data.group_column = input.inputs[2].GetValue<string>();
+}
+
+//===--------------------------------------------------------------------===//
+// vector_analyze
+//===--------------------------------------------------------------------===//
+struct VectorAnalyzeState : public GlobalTableFunctionState {
+	string bounds_table;
+	int64_t groups = 0;
+	bool finished = false;
+};
+
+static unique_ptr<FunctionData> VectorAnalyzeBind(ClientContext &context, TableFunctionBindInput &input,
+                                                  vector<LogicalType> &return_types, vector<string> &names) {
+	auto result = make_uniq<VectorBoundsBindData>();
+	VectorBoundsBind(*result, input);
+	return_types = {LogicalType::VARCHAR, LogicalType::BIGINT};
+	names = {"bounds_table", "groups"};
+	return std::move(result);
+}
+
+// (Re)builds the bounds table, the bounds are not maintained on INSERT or UPDATE
+static unique_ptr<GlobalTableFunctionState> VectorAnalyzeInit(ClientContext &context, TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<VectorBoundsBindData>();
+	auto result = make_uniq<VectorAnalyzeState>();
+	result->bounds_table = bind_data.BoundsTable();
+
+	auto column = Quote(bind_data.column);
+	auto group_column = Quote(bind_data.group_column);
+	Connection con(DatabaseInstance::GetDatabase(context));
+	RunQuery(con, StringUtil::Format("CREATE OR REPLACE TABLE %s AS SELECT %s, list_min_bound(%s) AS lower, "
+	                                 "list_max_bound(%s) AS upper FROM %s GROUP BY %s",
+	                                 Quote(result->bounds_table), group_column, column, column,
+	                                 Quote(bind_data.table), group_column));
+	auto groups = RunQuery(con, StringUtil::Format("SELECT count(*) FROM %s", Quote(result->bounds_table)));
+	result->groups = groups->GetValue(0, 0).GetValue<int64_t>();
+	return std::move(result);
+}
+
+static void VectorAnalyzeFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<VectorAnalyzeState>();
+	if (state.finished) {
+		return;
+	}
+	output.SetValue(0, 0, Value(state.bounds_table));
+	output.SetValue(1, 0, Value::BIGINT(state.groups));
+	output.SetCardinality(1);
+	state.finished = true;
+}
+
+//===--------------------------------------------------------------------===//
+// vector_range_search / vector_topk_search
+//===--------------------------------------------------------------------===//
+struct VectorSearchState : public GlobalTableFunctionState {
+	vector<VectorSearchMatch> matches;
+	idx_t offset = 0;
+};
+
+static void VectorSearchBind(VectorSearchBindData &bind_data, TableFunctionBindInput &input,
+                             vector<LogicalType> &return_types, vector<string> &names) {
+	VectorBoundsBind(bind_data, input);
+	if (input.inputs[3].IsNull()) {
+		throw BinderException("Search vector must not be NULL");
+	}
+	for (auto &element : ListValue::GetChildren(input.inputs[3])) {
+		bind_data.search_l.push_back(CheckElement(element));
+	}
+	if (input.inputs[4].IsNull()) {
+		throw BinderException("Search limit must not be NULL");
+	}
+	return_types = {LogicalType::BIGINT, LogicalType::LIST(LogicalType::DOUBLE), LogicalType::DOUBLE};
+	names = {"row_id", "vector", "distance"};
+}
+
+static unique_ptr<FunctionData> VectorRangeSearchBind(ClientContext &context, TableFunctionBindInput &input,
+                                                      vector<LogicalType> &return_types, vector<string> &names) {
+	auto result = make_uniq<VectorSearchBindData>();
+	VectorSearchBind(*result, input, return_types, names);
+	result->radius = input.inputs[4].GetValue<double>();
+	if (std::isnan(result->radius)) {
+		throw BinderException("Radius must not be NaN");
+	}
+	return std::move(result);
+}
+
+static unique_ptr<FunctionData> VectorTopKSearchBind(ClientContext &context, TableFunctionBindInput &input,
+                                                     vector<LogicalType> &return_types, vector<string> &names) {
+	auto result = make_uniq<VectorSearchBindData>();
+	VectorSearchBind(*result, input, return_types, names);
+	auto k = input.inputs[4].GetValue<int64_t>();
+	if (k < 0) {
+		throw BinderException("k must not be negative");
+	}
+	result->k = k;
+	return std::move(result);
+}
+
+// Lower bound of the distance from the search vector to every group, sorted by increasing bound
+static vector<VectorGroupBound> LoadGroupBounds(Connection &con, const VectorSearchBindData &bind_data) {
+	auto result = RunQuery(con, StringUtil::Format("SELECT %s, lower, upper FROM %s", Quote(bind_data.group_column),
+	                                               Quote(bind_data.BoundsTable())));
+	vector<VectorGroupBound> groups;
+	for (idx_t row = 0; row < result->RowCount(); row++) {
+		auto lower_value = result->GetValue(1, row);
+		auto upper_value = result->GetValue(2, row);
+		// the group only holds NULL vectors
+		if (lower_value.IsNull() || upper_value.IsNull()) {
+			continue;
+		}
+		auto &lower = ListValue::GetChildren(lower_value);
+		auto &upper = ListValue::GetChildren(upper_value);
+		CheckDimension(bind_data.search_l.size(), lower.size());
+		CheckDimension(bind_data.search_l.size(), upper.size());
+
+		double bound = 0;
+		for (idx_t j = 0; j < bind_data.search_l.size(); j++) {
+			auto delta = ListBoundsFun::BoxDelta(bind_data.search_l[j], CheckElement(lower[j]), CheckElement(upper[j]));
+			bound += delta * delta;
+		}
+		groups.push_back(VectorGroupBound {result->GetValue(0, row), sqrt(bound)});
+	}
+	std::sort(groups.begin(), groups.end(),
+	          [](const VectorGroupBound &a, const VectorGroupBound &b) { return a.bound < b.bound; });
+	return groups;
+}
+
+// Reads the vectors of the groups that survive pruning and scores them against the search vector
+class VectorGroupScanner {
+public:
+	using callback_t = std::function<void(int64_t row_id, const vector<double> &values, double distance)>;
+
+	VectorGroupScanner(Connection &con, const VectorSearchBindData &bind_data) : search_l(bind_data.search_l) {
+		auto select = StringUtil::Format("SELECT rowid, %s::DOUBLE[] FROM %s WHERE %s ", Quote(bind_data.column),
+		                                 Quote(bind_data.table), Quote(bind_data.group_column));
+		group_statement = con.Prepare(select + "= $1");
+		null_group_statement = con.Prepare(select + "IS NULL");
+		for (auto statement : {group_statement.get(), null_group_statement.get()}) {
+			if (statement->HasError()) {
+				throw InvalidInputException(statement->GetError());
+			}
+		}
+	}
+
+	void Scan(const Value &group, const callback_t &callback) {
+		vector<Value> parameters;
+		unique_ptr<QueryResult> result;
+		if (group.IsNull()) {
+			result = null_group_statement->Execute(parameters, false);
+		} else {
+			parameters.push_back(group);
+			result = group_statement->Execute(parameters, false);
+		}
+		if (result->HasError()) {
+			throw InvalidInputException(result->GetError());
+		}
+
+		vector<double> values(search_l.size());
+		while (true) {
+			auto chunk = result->Fetch();
+			if (!chunk || chunk->size() == 0) {
+				break;
+			}
+			auto count = chunk->size();
+
+			UnifiedVectorFormat row_id_data;
+			chunk->data[0].ToUnifiedFormat(count, row_id_data);
+			auto row_ids = UnifiedVectorFormat::GetData<int64_t>(row_id_data);
+
+			auto &list = chunk->data[1];
+			UnifiedVectorFormat list_data;
+			list.ToUnifiedFormat(count, list_data);
+			auto entries = UnifiedVectorFormat::GetData<list_entry_t>(list_data);
+			UnifiedVectorFormat child_data;
+			ListVector::GetEntry(list).ToUnifiedFormat(ListVector::GetListSize(list), child_data);
+			auto child_values = UnifiedVectorFormat::GetData<double>(child_data);
+
+			for (idx_t i = 0; i < count; i++) {
+				auto list_idx = list_data.sel->get_index(i);
+				if (!list_data.validity.RowIsValid(list_idx)) {
+					continue;
+				}
+				const auto &entry = entries[list_idx];
+				CheckDimension(search_l.size(), entry.length);
+
+				double distance = 0;
+				for (idx_t j = 0; j < entry.length; j++) {
+					auto child_idx = child_data.sel->get_index(entry.offset + j);
+					if (!child_data.validity.RowIsValid(child_idx)) {
+						throw InvalidInputException("Vector elements must not be NULL");
+					}
+					values[j] = child_values[child_idx];
+					distance += (values[j] - search_l[j]) * (values[j] - search_l[j]);
+				}
+				distance = sqrt(distance);
+				if (std::isnan(distance)) {
+					throw InvalidInputException("Vector elements must not be NaN");
+				}
+				callback(row_ids[row_id_data.sel->get_index(i)], values, distance);
+			}
+		}
+	}
+
+private:
+	const vector<double> &search_l;
+	unique_ptr<PreparedStatement> group_statement;
+	unique_ptr<PreparedStatement> null_group_statement;
+};
+
+static bool VectorSearchMatchLess(const VectorSearchMatch &a, const VectorSearchMatch &b) {
+	return a.distance < b.distance || (a.distance == b.distance && a.row_id < b.row_id);
+}
+
+// Returns the vectors within `radius` of the search vector, skipping groups whose lower bound exceeds it
+static unique_ptr<GlobalTableFunctionState> VectorRangeSearchInit(ClientContext &context,
+                                                                  TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<VectorSearchBindData>();
+	auto result = make_uniq<VectorSearchState>();
+
+	Connection con(DatabaseInstance::GetDatabase(context));
+	auto groups = LoadGroupBounds(con, bind_data);
+	VectorGroupScanner scanner(con, bind_data);
+	auto &matches = result->matches;
+	for (auto &group : groups) {
+		if (group.bound > bind_data.radius) {
+			// groups are sorted by their bound, none of the remaining groups can hold a match
+			break;
+		}
+		scanner.Scan(group.group, [&](int64_t row_id, const vector<double> &values, double distance) {
+			if (distance <= bind_data.radius) {
+				matches.push_back(VectorSearchMatch {row_id, values, distance});
+			}
+		});
+	}
+	std::sort(matches.begin(), matches.end(), VectorSearchMatchLess);
+	return std::move(result);
+}
+
+// Returns the `k` vectors closest to the search vector.
+// Groups are scanned by increasing lower bound, and the scan stops once the next bound exceeds the k-th best distance.
+static unique_ptr<GlobalTableFunctionState> VectorTopKSearchInit(ClientContext &context,
+                                                                 TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<VectorSearchBindData>();
+	auto result = make_uniq<VectorSearchState>();
+	if (bind_data.k == 0) {
+		return std::move(result);
+	}
+
+	Connection con(DatabaseInstance::GetDatabase(context));
+	auto groups = LoadGroupBounds(con, bind_data);
+	VectorGroupScanner scanner(con, bind_data);
+	// max-heap on the distance, the front is the k-th best match so far
+	auto &best = result->matches;
+	for (auto &group : groups) {
+		if (best.size() == bind_data.k && group.bound > best.front().distance) {
+			break;
+		}
+		scanner.Scan(group.group, [&](int64_t row_id, const vector<double> &values, double distance) {
+			VectorSearchMatch match {row_id, values, distance};
+			if (best.size() == bind_data.k) {
+				if (!VectorSearchMatchLess(match, best.front())) {
+					return;
+				}
+				std::pop_heap(best.begin(), best.end(), VectorSearchMatchLess);
+				best.pop_back();
+			}
+			best.push_back(std::move(match));
+			std::push_heap(best.begin(), best.end(), VectorSearchMatchLess);
+		});
+	}
+	std::sort_heap(best.begin(), best.end(), VectorSearchMatchLess);
+	return std::move(result);
+}
+
+static void VectorSearchFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<VectorSearchState>();
+	auto row_ids = FlatVector::GetData<int64_t>(output.data[0]);
+	auto &vectors = output.data[1];
+	auto vector_entries = FlatVector::GetData<list_entry_t>(vectors);
+	auto distances = FlatVector::GetData<double>(output.data[2]);
+
+	idx_t count = 0;
+	while (state.offset < state.matches.size() && count < STANDARD_VECTOR_SIZE) {
+		auto &match = state.matches[state.offset++];
+		row_ids[count] = match.row_id;
+		distances[count] = match.distance;
+
+		auto list_size = ListVector::GetListSize(vectors);
+		ListVector::Reserve(vectors, list_size + match.values.size());
+		auto child_values = FlatVector::GetData<double>(ListVector::GetEntry(vectors));
+		for (idx_t j = 0; j < match.values.size(); j++) {
+			child_values[list_size + j] = match.values[j];
+		}
+		vector_entries[count].offset = list_size;
+		vector_entries[count].length = match.values.size();
+		ListVector::SetListSize(vectors, list_size + match.values.size());
+		count++;
+	}
+	output.SetCardinality(count);
+}
+
+// Calls are of the form:
+// vector_analyze(table, column, group_column)
+// vector_range_search(table, column, group_column, search_l, radius)
+// vector_topk_search(table, column, group_column, search_l, k)
+vector<TableFunction> VectorSearchFun::GetFunctions() {
+	vector<TableFunction> functions;
+	vector<LogicalType> arguments = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::VARCHAR};
+	functions.push_back(
+	    TableFunction("vector_analyze", arguments, VectorAnalyzeFunction, VectorAnalyzeBind, VectorAnalyzeInit));
+
+	arguments.push_back(LogicalType::LIST(LogicalType::DOUBLE));
+	functions.push_back(TableFunction("vector_range_search", {arguments[0], arguments[1], arguments[2], arguments[3],
+	                                                          LogicalType::DOUBLE},
+	                                  VectorSearchFunction, VectorRangeSearchBind, VectorRangeSearchInit));
+	functions.push_back(TableFunction("vector_topk_search", {arguments[0], arguments[1], arguments[2], arguments[3],
+	                                                         LogicalType::BIGINT},
+	                                  VectorSearchFunction, VectorTopKSearchBind, VectorTopKSearchInit));
+	return functions;
+}
+
+} // namespace duckdb